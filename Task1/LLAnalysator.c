@@ -1,25 +1,82 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
 #include <stdbool.h>
 #include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "analyzers.h"
+#include "reader.h"
+#include "series_scan.h"
 
 #define MAX_STACK 100
+#define WRITE_BUFFER (1 << 16)
+#define RESULT_SIZE 320
+#define LINE_BATCH 4096
+#define LINES_PER_JOB 64
+#define SPLIT_MIN_LENGTH (1 << 16)
+#define CHUNKS_PER_THREAD 4
 
 typedef enum {
-    TOK_1, TOK_PLUS, TOK_SLASH, TOK_LPAREN, TOK_RPAREN, TOK_MUL, TOK_DIGIT, TOK_END, TOK_INVALID
+    TOK_1, TOK_PLUS, TOK_SLASH, TOK_LPAREN, TOK_RPAREN, TOK_MUL, TOK_DIGIT, TOK_END, TOK_INVALID, TOK_COUNT
 } TokenType;
 
+// Нетерминалы грамматики. CHUNK - часть длинного ряда после '+', используется в режиме -s.
+typedef enum {
+    NT_S, NT_S_PRIME, NT_F, NT_CHUNK, NT_COUNT
+} NonTerminal;
+
+// Семантические действия: выполняются, когда их символ снимается со стека разбора
+typedef enum {
+    ACT_SUM_ONE, ACT_SUM_ZERO, ACT_SET_A, ACT_SET_B, ACT_CHECK_PRODUCT, ACT_ADD_TERM
+} Action;
+
+// Символы стека: терминалы - значения TokenType, за ними нетерминалы, затем действия
+#define NT(n) (TOK_COUNT + (n))
+#define ACT(a) (TOK_COUNT + NT_COUNT + (a))
+#define MAX_RHS 12
+
+typedef struct {
+    NonTerminal lhs;
+    int rhs[MAX_RHS];
+    int length;
+} Production;
+
+// S  -> 1 S'
+// S' -> + F S' | ε
+// F  -> 1 / ( N * N )
+// CHUNK -> F S'
+static const Production grammar[] = {
+    {NT_S, {TOK_1, ACT(ACT_SUM_ONE), NT(NT_S_PRIME)}, 3},
+    {NT_S_PRIME, {TOK_PLUS, NT(NT_F), ACT(ACT_ADD_TERM), NT(NT_S_PRIME)}, 4},
+    {NT_S_PRIME, {0}, 0},
+    {NT_F, {TOK_1, TOK_SLASH, TOK_LPAREN, TOK_DIGIT, ACT(ACT_SET_A), TOK_MUL, TOK_DIGIT, ACT(ACT_SET_B),
+            TOK_RPAREN, ACT(ACT_CHECK_PRODUCT)}, 10},
+    {NT_CHUNK, {ACT(ACT_SUM_ZERO), NT(NT_F), ACT(ACT_ADD_TERM), NT(NT_S_PRIME)}, 4},
+};
+
+#define PRODUCTION_COUNT ((int)(sizeof(grammar) / sizeof(grammar[0])))
+
 typedef struct {
     TokenType type;
     int value;
-    int pos;
+    size_t pos;
 } Token;
 
+typedef enum {
+    MODE_STREAM, MODE_LINES, MODE_SPLIT
+} RunMode;
+
 typedef struct {
-    const char *input;
-    int pos;
+    Reader *in;
+    size_t pos;
     Token lookahead;
+    Token last;
     bool has_error;
+    bool overflow;
+    bool cut_end;
     char error_msg[256];
     long long sum_num;
     long long sum_den;
@@ -27,78 +84,108 @@ typedef struct {
     int current_b;
 } Parser;
 
-void skip_whitespace(Parser *p) {
-    while (p->input[p->pos] != '\0' && isspace(p->input[p->pos])) {
-        p->pos++;
+static char peek(Parser *p, int k) {
+    return series_peek(p->in, k);
+}
+
+static void bump(Parser *p) {
+    p->in->cur++;
+    p->pos++;
+}
+
+static void bump_n(Parser *p, int n) {
+    p->in->cur += n;
+    p->pos += n;
+}
+
+static void skip_whitespace(Parser *p) {
+    while (peek(p, 0) != '\0' && isspace(peek(p, 0))) {
+        bump(p);
     }
 }
 
-Token get_next_token(Parser *p) {
+static Token get_next_token(Parser *p) {
     skip_whitespace(p);
     Token tok = {TOK_INVALID, 0, p->pos};
-    char c = p->input[p->pos];
+    char c = peek(p, 0);
     
-    if (c == '\0') {
+    if (c == '\0' && reader_at_line_end(p->in, 0)) {
         tok.type = TOK_END;
-    } else if (c == '1' && (p->input[p->pos + 1] == '/' || p->pos == 0)) {
+    } else if (c == '1' && !isdigit(peek(p, 1))) {
+        // Отдельная "1" - терминал грамматики; там, где ожидается N, match принимает её как число 1
         tok.type = TOK_1;
-        p->pos++;
+        tok.value = 1;
+        bump(p);
     } else if (c == '+') {
         tok.type = TOK_PLUS;
-        p->pos++;
+        bump(p);
     } else if (c == '/') {
         tok.type = TOK_SLASH;
-        p->pos++;
+        bump(p);
     } else if (c == '(') {
         tok.type = TOK_LPAREN;
-        p->pos++;
+        bump(p);
     } else if (c == ')') {
         tok.type = TOK_RPAREN;
-        p->pos++;
+        bump(p);
     } else if (c == '*') {
         tok.type = TOK_MUL;
-        p->pos++;
+        bump(p);
     } else if (isdigit(c)) {
         tok.type = TOK_DIGIT;
-        tok.value = 0;
-        int start_pos = p->pos;
-        while (isdigit(p->input[p->pos])) {
-            int digit = p->input[p->pos] - '0';
+        size_t start_pos = p->pos;
+        bool leading_zero = c == '0';
+        // До 8 цифр разбираются одним словом; они не превышают INT_MAX, проверка нужна только дальше
+        size_t available;
+        const char *digits = reader_window(p->in, 8, &available);
+        bump_n(p, parse_digits_swar(digits, available, &tok.value));
+        while (isdigit(peek(p, 0))) {
+            int digit = peek(p, 0) - '0';
             if (tok.value > (INT_MAX - digit) / 10) {
-                sprintf(p->error_msg, "Ошибка: Число превышает INT_MAX (позиция %d)", start_pos);
+                sprintf(p->error_msg, "Ошибка: Число превышает INT_MAX (позиция %zu)", start_pos);
                 p->has_error = true;
                 return tok;
             }
             tok.value = tok.value * 10 + digit;
-            p->pos++;
+            bump(p);
         }
-        if (p->input[start_pos] == '0' && tok.value != 0) {
-            sprintf(p->error_msg, "Ошибка: Натуральное число не может начинаться с '0' (позиция %d)", start_pos);
+        if (leading_zero && tok.value != 0) {
+            sprintf(p->error_msg, "Ошибка: Натуральное число не может начинаться с '0' (позиция %zu)", start_pos);
             p->has_error = true;
         }
     } else {
-        sprintf(p->error_msg, "Ошибка: Неизвестный символ '%c' (позиция %d)", c, p->pos);
+        char found[8];
+        sprintf(p->error_msg, "Ошибка: Неизвестный символ %s (позиция %zu)",
+                reader_char_text(p->in, 0, found, sizeof(found)), p->pos);
         p->has_error = true;
     }
     return tok;
 }
 
-void init_parser(Parser *p, const char *input) {
-    p->input = input;
-    p->pos = 0;
+// pos задаёт позицию первого символа: при разбиении ряда на части ошибки указывают место во всей строке
+static void init_parser_at(Parser *p, Reader *in, size_t pos) {
+    p->in = in;
+    p->pos = pos;
     p->has_error = false;
+    p->overflow = false;
+    p->cut_end = false;
+    p->error_msg[0] = '\0';
     p->sum_num = 1;
     p->sum_den = 1;
     p->lookahead = get_next_token(p);
 }
 
-void advance(Parser *p) {
+static void init_parser(Parser *p, Reader *in) {
+    init_parser_at(p, in, 0);
+}
+
+static void advance(Parser *p) {
     if (!p->has_error && p->lookahead.type != TOK_END) {
         p->lookahead = get_next_token(p);
     }
 }
 
-const char* token_type_to_str(TokenType type) {
+static const char* token_type_to_str(TokenType type) {
     switch (type) {
         case TOK_1: return "'1'";
         case TOK_PLUS: return "'+'";
@@ -112,20 +199,29 @@ const char* token_type_to_str(TokenType type) {
     }
 }
 
-bool match(Parser *p, TokenType expected) {
-    if (p->lookahead.type == expected) {
+// Часть ряда в режиме -s кончается там, где отрезан '+': в сообщениях об ошибках это '+', а не конец строки
+static const char *found_token_str(Parser *p) {
+    if (p->lookahead.type == TOK_END && p->cut_end) {
+        return token_type_to_str(TOK_PLUS);
+    }
+    return token_type_to_str(p->lookahead.type);
+}
+
+static bool match(Parser *p, TokenType expected) {
+    if (p->lookahead.type == expected || (expected == TOK_DIGIT && p->lookahead.type == TOK_1)) {
+        p->last = p->lookahead;
         advance(p);
         return true;
     }
-    sprintf(p->error_msg, "Ошибка: Ожидалось %s, но найдено %s (позиция %d)", 
+    sprintf(p->error_msg, "Ошибка: Ожидалось %s, но найдено %s (позиция %zu)", 
             token_type_to_str(expected), 
-            token_type_to_str(p->lookahead.type), 
+            found_token_str(p), 
             p->lookahead.pos);
     p->has_error = true;
     return false;
 }
 
-long long compute_gcd(long long a, long long b) {
+static long long compute_gcd(long long a, long long b) {
     while (b != 0) {
         long long temp = b;
         b = a % b;
@@ -134,91 +230,680 @@ long long compute_gcd(long long a, long long b) {
     return a;
 }
 
-bool parse_N(Parser *p, int *value) {
-    if (p->lookahead.type != TOK_DIGIT || p->lookahead.value < 1) {
-        sprintf(p->error_msg, "Ошибка: Ожидалось натуральное число ≥1 (позиция %d)", p->lookahead.pos);
+// *num/ *den += n/d с сокращением; false, если результат не помещается в long long.
+// Знаменатели сначала сокращаются на общий делитель, чтобы промежуточные значения оставались малыми.
+static bool add_fraction(long long *num, long long *den, long long n, long long d) {
+    long long g = compute_gcd(*den, d);
+    long long left = d / g;
+    long long right = *den / g;
+    if (*num > LLONG_MAX / left || n > LLONG_MAX / right || *den > LLONG_MAX / left) {
+        return false;
+    }
+    long long new_num = *num * left;
+    long long addend = n * right;
+    if (new_num > LLONG_MAX - addend) {
+        return false;
+    }
+    new_num += addend;
+    long long new_den = *den * left;
+    long long gcd = compute_gcd(new_num, new_den);
+    *num = new_num / gcd;
+    *den = new_den / gcd;
+    return true;
+}
+
+// Таблица разбора LL(1): номер продукции для пары (нетерминал, токен) или -1
+typedef struct {
+    int entries[NT_COUNT][TOK_COUNT];
+    bool ready;
+} ParseTable;
+
+static ParseTable parse_table;
+static pthread_once_t parse_table_once = PTHREAD_ONCE_INIT;
+
+static bool is_terminal(int symbol) {
+    return symbol < TOK_COUNT;
+}
+
+static bool is_nonterminal(int symbol) {
+    return symbol >= TOK_COUNT && symbol < TOK_COUNT + NT_COUNT;
+}
+
+// FIRST и FOLLOW хранятся как битовые маски по TokenType; конец строки (TOK_END) играет роль '$'.
+// Действия в правых частях прозрачны: они ничего не порождают и не мешают ε-выводу.
+static void build_parse_table(void) {
+    unsigned first[NT_COUNT] = {0};
+    unsigned follow[NT_COUNT] = {0};
+    bool nullable[NT_COUNT] = {false};
+    follow[NT_S] = follow[NT_CHUNK] = 1u << TOK_END;
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 0; i < PRODUCTION_COUNT; i++) {
+            const Production *prod = &grammar[i];
+            bool rest_nullable = true;
+            for (int j = 0; j < prod->length && rest_nullable; j++) {
+                int symbol = prod->rhs[j];
+                if (is_terminal(symbol)) {
+                    changed |= !(first[prod->lhs] & (1u << symbol));
+                    first[prod->lhs] |= 1u << symbol;
+                    rest_nullable = false;
+                } else if (is_nonterminal(symbol)) {
+                    int nt = symbol - TOK_COUNT;
+                    changed |= (first[nt] & ~first[prod->lhs]) != 0;
+                    first[prod->lhs] |= first[nt];
+                    rest_nullable = nullable[nt];
+                }
+            }
+            if (rest_nullable && !nullable[prod->lhs]) {
+                nullable[prod->lhs] = true;
+                changed = true;
+            }
+        }
+    }
+
+    changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 0; i < PRODUCTION_COUNT; i++) {
+            const Production *prod = &grammar[i];
+            // Идём справа налево, накапливая FIRST хвоста правой части
+            unsigned trailer = follow[prod->lhs];
+            for (int j = prod->length - 1; j >= 0; j--) {
+                int symbol = prod->rhs[j];
+                if (is_terminal(symbol)) {
+                    trailer = 1u << symbol;
+                } else if (is_nonterminal(symbol)) {
+                    int nt = symbol - TOK_COUNT;
+                    changed |= (trailer & ~follow[nt]) != 0;
+                    follow[nt] |= trailer;
+                    trailer = nullable[nt] ? trailer | first[nt] : first[nt];
+                }
+            }
+        }
+    }
+
+    for (int nt = 0; nt < NT_COUNT; nt++) {
+        for (int t = 0; t < TOK_COUNT; t++) {
+            parse_table.entries[nt][t] = -1;
+        }
+    }
+    parse_table.ready = true;
+    for (int i = 0; i < PRODUCTION_COUNT; i++) {
+        const Production *prod = &grammar[i];
+        unsigned predict = 0;
+        bool rest_nullable = true;
+        for (int j = 0; j < prod->length && rest_nullable; j++) {
+            int symbol = prod->rhs[j];
+            if (is_terminal(symbol)) {
+                predict |= 1u << symbol;
+                rest_nullable = false;
+            } else if (is_nonterminal(symbol)) {
+                predict |= first[symbol - TOK_COUNT];
+                rest_nullable = nullable[symbol - TOK_COUNT];
+            }
+        }
+        if (rest_nullable) {
+            predict |= follow[prod->lhs];
+        }
+        for (int t = 0; t < TOK_COUNT; t++) {
+            if (!(predict & (1u << t))) continue;
+            if (parse_table.entries[prod->lhs][t] != -1) {
+                fprintf(stderr, "Ошибка: Грамматика не LL(1): конфликт для %s\n", token_type_to_str(t));
+                parse_table.ready = false;
+            }
+            parse_table.entries[prod->lhs][t] = i;
+        }
+    }
+}
+
+// Стек разбора: первые MAX_STACK символов лежат в самой структуре, дальше он растёт в куче
+typedef struct {
+    int inline_items[MAX_STACK];
+    int *items;
+    int size;
+    int capacity;
+} SymbolStack;
+
+static void stack_init(SymbolStack *st) {
+    st->items = st->inline_items;
+    st->size = 0;
+    st->capacity = MAX_STACK;
+}
+
+static bool stack_push(SymbolStack *st, int symbol) {
+    if (st->size == st->capacity) {
+        int *items = st->items == st->inline_items ? malloc(2 * st->capacity * sizeof(int))
+                                                   : realloc(st->items, 2 * st->capacity * sizeof(int));
+        if (!items) return false;
+        if (st->items == st->inline_items) {
+            memcpy(items, st->inline_items, sizeof(st->inline_items));
+        }
+        st->items = items;
+        st->capacity *= 2;
+    }
+    st->items[st->size++] = symbol;
+    return true;
+}
+
+static void stack_free(SymbolStack *st) {
+    if (st->items != st->inline_items) {
+        free(st->items);
+    }
+}
+
+static bool take_natural(Parser *p, int *value) {
+    if (p->last.value < 1) {
+        sprintf(p->error_msg, "Ошибка: Ожидалось натуральное число ≥1 (позиция %zu)", p->last.pos);
         p->has_error = true;
         return false;
     }
-    *value = p->lookahead.value;
-    match(p, TOK_DIGIT);
+    *value = p->last.value;
     return true;
 }
 
-void parse_F(Parser *p) {
-    match(p, TOK_1);
-    match(p, TOK_SLASH);
-    match(p, TOK_LPAREN);
-    int a, b;
-    if (!parse_N(p, &a)) return;
-    match(p, TOK_MUL);
-    if (!parse_N(p, &b)) return;
-    match(p, TOK_RPAREN);
-    
-    long long product = (long long)a * b;
-    if (product > INT_MAX) {
-        sprintf(p->error_msg, "Ошибка: Произведение %d*%d превышает INT_MAX (позиция %d)", a, b, p->lookahead.pos);
+static void run_action(Parser *p, Action action) {
+    switch (action) {
+        case ACT_SUM_ONE:
+            p->sum_num = 1;
+            p->sum_den = 1;
+            break;
+        case ACT_SUM_ZERO:
+            p->sum_num = 0;
+            p->sum_den = 1;
+            break;
+        case ACT_SET_A:
+            take_natural(p, &p->current_a);
+            break;
+        case ACT_SET_B:
+            take_natural(p, &p->current_b);
+            break;
+        case ACT_CHECK_PRODUCT:
+            if ((long long)p->current_a * p->current_b > INT_MAX) {
+                sprintf(p->error_msg, "Ошибка: Произведение %d*%d превышает INT_MAX (позиция %zu)",
+                        p->current_a, p->current_b, p->lookahead.pos);
+                p->has_error = true;
+            }
+            break;
+        case ACT_ADD_TERM:
+            if (!add_fraction(&p->sum_num, &p->sum_den, 1, (long long)p->current_a * p->current_b)) {
+                sprintf(p->error_msg, "Ошибка: Переполнение при вычислении суммы (позиция %zu)", p->lookahead.pos);
+                p->has_error = true;
+                p->overflow = true;
+            }
+            break;
+    }
+}
+
+static void expected_error(Parser *p, NonTerminal nt) {
+    char expected[128] = "";
+    size_t len = 0;
+    for (int t = 0; t < TOK_COUNT; t++) {
+        if (parse_table.entries[nt][t] == -1) continue;
+        len += snprintf(expected + len, sizeof(expected) - len, "%s%s",
+                        len > 0 ? " или " : "", token_type_to_str(t));
+        if (len >= sizeof(expected)) break;
+    }
+    sprintf(p->error_msg, "Ошибка: Ожидалось %s, но найдено %s (позиция %zu)",
+            expected, found_token_str(p), p->lookahead.pos);
+    p->has_error = true;
+}
+
+// Табличный LL(1)-разбор от start до конца строки. Глубина рекурсии C не зависит от длины ряда:
+// всё состояние разбора лежит в SymbolStack.
+static void parse_from(Parser *p, NonTerminal start) {
+    pthread_once(&parse_table_once, build_parse_table);
+    if (!parse_table.ready) {
+        sprintf(p->error_msg, "Ошибка: Таблица разбора не построена");
         p->has_error = true;
         return;
     }
-    p->current_a = a;
-    p->current_b = b;
-}
-
-void parse_S_prime(Parser *p) {
-    if (p->lookahead.type == TOK_PLUS) {
-        match(p, TOK_PLUS);
-        parse_F(p);
-        if (p->has_error) return;
-        
-        long long a = p->current_a;
-        long long b = p->current_b;
-        long long den = a * b;
-        long long num = 1;
-        
-        long long new_num = p->sum_num * den + p->sum_den * num;
-        long long new_den = p->sum_den * den;
-        long long gcd = compute_gcd(new_num, new_den);
-        p->sum_num = new_num / gcd;
-        p->sum_den = new_den / gcd;
-        
-        parse_S_prime(p);
-    }
-}
-
-void parse_S(Parser *p) {
-    if (p->lookahead.type == TOK_1) {
-        p->sum_num = 1;
-        p->sum_den = 1;
-        match(p, TOK_1);
-        if (p->lookahead.type == TOK_SLASH) {
-            parse_F(p);
-            if (p->has_error) return;
-            long long a = p->current_a;
-            long long b = p->current_b;
-            p->sum_num = 1;
-            p->sum_den = a * b;
+
+    SymbolStack st;
+    stack_init(&st);
+    stack_push(&st, TOK_END);
+    stack_push(&st, NT(start));
+    while (st.size > 0 && !p->has_error) {
+        int symbol = st.items[--st.size];
+        if (is_terminal(symbol)) {
+            match(p, symbol);
+        } else if (is_nonterminal(symbol)) {
+            int index = parse_table.entries[symbol - TOK_COUNT][p->lookahead.type];
+            if (index == -1) {
+                expected_error(p, symbol - TOK_COUNT);
+                break;
+            }
+            const Production *prod = &grammar[index];
+            for (int j = prod->length - 1; j >= 0; j--) {
+                if (!stack_push(&st, prod->rhs[j])) {
+                    sprintf(p->error_msg, "Ошибка: Не удалось увеличить стек разбора");
+                    p->has_error = true;
+                    break;
+                }
+            }
+        } else {
+            run_action(p, symbol - TOK_COUNT - NT_COUNT);
         }
-        parse_S_prime(p);
-    } else {
-        sprintf(p->error_msg, "Ошибка: Ожидалось '1' (позиция %d)", p->lookahead.pos);
-        p->has_error = true;
     }
+    stack_free(&st);
 }
 
-void parse(const char *input) {
+void ll_check_series(const char *series, size_t len, SeriesResult *result) {
+    Reader in;
+    reader_from_buffer(&in, series, len);
     Parser p;
-    init_parser(&p, input);
-    parse_S(&p);
-    
-    if (!p.has_error && p.lookahead.type == TOK_END) {
-        printf("✅ Корректный ряд! Сумма: %lld/%lld\n", p.sum_num, p.sum_den);
+    init_parser(&p, &in);
+    parse_from(&p, NT_S);
+    result->verdict = !p.has_error ? SERIES_OK : p.overflow ? SERIES_OVERFLOW : SERIES_SYNTAX_ERROR;
+    result->num = p.sum_num;
+    result->den = p.sum_den;
+    snprintf(result->error_msg, sizeof(result->error_msg), "%s", p.has_error ? p.error_msg : "");
+}
+
+#ifndef ANALYZER_LIBRARY
+static void format_result(bool ok, long long num, long long den, const char *error_msg, char *out, size_t size) {
+    if (ok) {
+        snprintf(out, size, "✅ Корректный ряд! Сумма: %lld/%lld\n", num, den);
     } else {
-        printf("❌ %s\n", p.error_msg);
+        snprintf(out, size, "❌ %s\n", error_msg);
     }
 }
 
-int main() {
+static void check_series(Reader *in, char *out, size_t size) {
+    Parser p;
+    init_parser(&p, in);
+    parse_from(&p, NT_S);
+    format_result(!p.has_error, p.sum_num, p.sum_den, p.error_msg, out, size);
+}
+
+static void parse_reader(Reader *in) {
+    char result[RESULT_SIZE];
+    check_series(in, result, sizeof(result));
+    fputs(result, stdout);
+}
+
+static void parse(const char *input) {
+    Reader in;
+    reader_from_string(&in, input);
+    parse_reader(&in);
+}
+
+// Потоковый режим: по одному ряду на строку, по одной строке результата на ряд.
+static int parse_stream(FILE *file) {
+    Reader in;
+    if (!reader_open(&in, file)) {
+        fprintf(stderr, "Ошибка: Не удалось выделить буфер чтения\n");
+        return 1;
+    }
+    while (!reader_at_end(&in)) {
+        parse_reader(&in);
+        reader_next_line(&in);
+    }
+    reader_close(&in);
+    return ferror(file) ? 1 : 0;
+}
+
+typedef struct {
+    void (*run)(void *arg);
+    void *arg;
+} Job;
+
+// Пул потоков с ограниченной очередью заданий: pool_submit ждёт, пока в очереди не появится место.
+typedef struct {
+    pthread_t *threads;
+    int thread_count;
+    Job *jobs;
+    int capacity;
+    int head;
+    int count;
+    int active;
+    bool stop;
+    pthread_mutex_t lock;
+    pthread_cond_t has_job;
+    pthread_cond_t has_room;
+    pthread_cond_t idle;
+} ThreadPool;
+
+static void *pool_worker(void *arg) {
+    ThreadPool *pool = arg;
+    pthread_mutex_lock(&pool->lock);
+    while (true) {
+        while (pool->count == 0 && !pool->stop) {
+            pthread_cond_wait(&pool->has_job, &pool->lock);
+        }
+        if (pool->count == 0) {
+            break;
+        }
+        Job job = pool->jobs[pool->head];
+        pool->head = (pool->head + 1) % pool->capacity;
+        pool->count--;
+        pool->active++;
+        pthread_cond_signal(&pool->has_room);
+        pthread_mutex_unlock(&pool->lock);
+
+        job.run(job.arg);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->active--;
+        if (pool->count == 0 && pool->active == 0) {
+            pthread_cond_broadcast(&pool->idle);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static void pool_destroy(ThreadPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->has_job);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->has_job);
+    pthread_cond_destroy(&pool->has_room);
+    pthread_cond_destroy(&pool->idle);
+    free(pool->threads);
+    free(pool->jobs);
+}
+
+static bool pool_init(ThreadPool *pool, int thread_count, int capacity) {
+    pool->threads = malloc(thread_count * sizeof(pthread_t));
+    pool->jobs = malloc(capacity * sizeof(Job));
+    if (!pool->threads || !pool->jobs) {
+        free(pool->threads);
+        free(pool->jobs);
+        return false;
+    }
+    pool->thread_count = 0;
+    pool->capacity = capacity;
+    pool->head = 0;
+    pool->count = 0;
+    pool->active = 0;
+    pool->stop = false;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->has_job, NULL);
+    pthread_cond_init(&pool->has_room, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+    while (pool->thread_count < thread_count &&
+           pthread_create(&pool->threads[pool->thread_count], NULL, pool_worker, pool) == 0) {
+        pool->thread_count++;
+    }
+    if (pool->thread_count == 0) {
+        pool_destroy(pool);
+        return false;
+    }
+    return true;
+}
+
+static void pool_submit(ThreadPool *pool, void (*run)(void *arg), void *arg) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->count == pool->capacity) {
+        pthread_cond_wait(&pool->has_room, &pool->lock);
+    }
+    pool->jobs[(pool->head + pool->count) % pool->capacity] = (Job){run, arg};
+    pool->count++;
+    pthread_cond_signal(&pool->has_job);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void pool_wait(ThreadPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->count > 0 || pool->active > 0) {
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+typedef struct {
+    char **lines;
+    size_t *lengths;
+    char (*results)[RESULT_SIZE];
+    int first;
+    int count;
+} LineJob;
+
+static void run_line_job(void *arg) {
+    LineJob *job = arg;
+    for (int i = job->first; i < job->first + job->count; i++) {
+        Reader in;
+        reader_from_buffer(&in, job->lines[i], job->lengths[i]);
+        check_series(&in, job->results[i], RESULT_SIZE);
+    }
+}
+
+// Параллельный режим для файлов из множества рядов: строки читаются пачками по LINE_BATCH,
+// проверяются в пуле, а результаты печатаются в исходном порядке.
+static int parallel_lines(FILE *file, ThreadPool *pool) {
+    char **lines = calloc(LINE_BATCH, sizeof(char *));
+    size_t *capacities = calloc(LINE_BATCH, sizeof(size_t));
+    size_t *lengths = malloc(LINE_BATCH * sizeof(size_t));
+    char (*results)[RESULT_SIZE] = malloc(LINE_BATCH * sizeof(*results));
+    LineJob *jobs = malloc((LINE_BATCH / LINES_PER_JOB + 1) * sizeof(LineJob));
+    int status = 0;
+    if (!lines || !capacities || !lengths || !results || !jobs) {
+        fprintf(stderr, "Ошибка: Не удалось выделить буфер чтения\n");
+        status = 1;
+    }
+
+    int count = LINE_BATCH;
+    while (status == 0 && count == LINE_BATCH) {
+        count = 0;
+        ssize_t len;
+        while (count < LINE_BATCH && (len = getline(&lines[count], &capacities[count], file)) != -1) {
+            lengths[count++] = len;
+        }
+
+        int job_count = 0;
+        for (int first = 0; first < count; first += LINES_PER_JOB) {
+            int rest = count - first;
+            jobs[job_count] = (LineJob){lines, lengths, results, first,
+                                        rest < LINES_PER_JOB ? rest : LINES_PER_JOB};
+            pool_submit(pool, run_line_job, &jobs[job_count]);
+            job_count++;
+        }
+        pool_wait(pool);
+        for (int i = 0; i < count; i++) {
+            fputs(results[i], stdout);
+        }
+    }
+
+    if (lines) {
+        for (int i = 0; i < LINE_BATCH; i++) {
+            free(lines[i]);
+        }
+    }
+    free(lines);
+    free(capacities);
+    free(lengths);
+    free(results);
+    free(jobs);
+    return status || ferror(file) ? 1 : 0;
+}
+
+typedef struct {
+    const char *text;
+    size_t len;
+    size_t offset;
+    bool first;
+    bool last;
+    bool ok;
+    long long sum_num;
+    long long sum_den;
+    char error_msg[256];
+} Chunk;
+
+static void run_chunk(void *arg) {
+    Chunk *chunk = arg;
+    Reader in;
+    reader_from_buffer(&in, chunk->text, chunk->len);
+    Parser p;
+    init_parser_at(&p, &in, chunk->offset);
+    p.cut_end = !chunk->last;
+    parse_from(&p, chunk->first ? NT_S : NT_CHUNK);
+    chunk->ok = !p.has_error;
+    chunk->sum_num = p.sum_num;
+    chunk->sum_den = p.sum_den;
+    strcpy(chunk->error_msg, p.error_msg);
+}
+
+// Режет ряд по знакам '+' примерно на max_chunks равных частей; сам '+' ни в одну часть не входит.
+static int split_series(const char *line, size_t len, Chunk *chunks, int max_chunks) {
+    int count = 0;
+    size_t start = 0;
+    for (int i = 1; i < max_chunks; i++) {
+        size_t end = len / max_chunks * i;
+        if (end < start) {
+            end = start;
+        }
+        while (end < len && line[end] != '+') {
+            end++;
+        }
+        if (end >= len) {
+            break;
+        }
+        chunks[count] = (Chunk){.text = line + start, .len = end - start, .offset = start, .first = count == 0};
+        count++;
+        start = end + 1;
+    }
+    chunks[count] = (Chunk){.text = line + start, .len = len - start, .offset = start, .first = count == 0,
+                            .last = true};
+    return count + 1;
+}
+
+// Складывает частичные суммы попарно деревом: на каждом уровне соседние суммы объединяются,
+// поэтому знаменатели растут равномерно, а не накапливаются в одном левом аккумуляторе.
+static void reduce_chunks(Chunk *chunks, int count) {
+    for (int i = 0; i < count; i++) {
+        if (!chunks[i].ok) {
+            if (i > 0) {
+                chunks[0] = chunks[i];
+            }
+            return;
+        }
+    }
+    for (int step = 1; step < count; step *= 2) {
+        for (int i = 0; i + step < count; i += 2 * step) {
+            Chunk *left = &chunks[i];
+            Chunk *right = &chunks[i + step];
+            if (!add_fraction(&left->sum_num, &left->sum_den, right->sum_num, right->sum_den)) {
+                sprintf(chunks[0].error_msg, "Ошибка: Переполнение при вычислении суммы (позиция %zu)",
+                        right->offset);
+                chunks[0].ok = false;
+                return;
+            }
+        }
+    }
+}
+
+// Параллельный режим для очень длинных рядов: строка делится на части по '+',
+// части суммируются в пуле, частичные суммы объединяются reduce_chunks.
+static int parallel_split(FILE *file, ThreadPool *pool) {
+    int max_chunks = pool->thread_count * CHUNKS_PER_THREAD;
+    Chunk *chunks = malloc(max_chunks * sizeof(Chunk));
+    if (!chunks) {
+        fprintf(stderr, "Ошибка: Не удалось выделить буфер чтения\n");
+        return 1;
+    }
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t len;
+    char result[RESULT_SIZE];
+    while ((len = getline(&line, &capacity, file)) != -1) {
+        if (len > 0 && line[len - 1] == '\n') {
+            len--;
+        }
+        int count = split_series(line, len, chunks, len < SPLIT_MIN_LENGTH ? 1 : max_chunks);
+        for (int i = 0; i < count; i++) {
+            pool_submit(pool, run_chunk, &chunks[i]);
+        }
+        pool_wait(pool);
+        reduce_chunks(chunks, count);
+        format_result(chunks[0].ok, chunks[0].sum_num, chunks[0].sum_den, chunks[0].error_msg,
+                      result, sizeof(result));
+        fputs(result, stdout);
+    }
+    free(line);
+    free(chunks);
+    return ferror(file) ? 1 : 0;
+}
+
+static int process_file(FILE *file, RunMode mode, ThreadPool *pool) {
+    switch (mode) {
+        case MODE_LINES: return parallel_lines(file, pool);
+        case MODE_SPLIT: return parallel_split(file, pool);
+        default: return parse_stream(file);
+    }
+}
+
+static int run_files(int count, char **paths, RunMode mode, int threads) {
+    static char out_buffer[WRITE_BUFFER];
+    setvbuf(stdout, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    ThreadPool pool;
+    if (mode != MODE_STREAM) {
+        if (threads < 1) {
+            long online = sysconf(_SC_NPROCESSORS_ONLN);
+            threads = online > 0 ? (int)online : 1;
+        }
+        if (!pool_init(&pool, threads, threads * CHUNKS_PER_THREAD)) {
+            fprintf(stderr, "Ошибка: Не удалось запустить потоки\n");
+            return 1;
+        }
+    }
+
+    int status = 0;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(paths[i], "-") == 0) {
+            status |= process_file(stdin, mode, &pool);
+            continue;
+        }
+        FILE *file = fopen(paths[i], "rb");
+        if (!file) {
+            fprintf(stderr, "Ошибка: Не удалось открыть файл %s\n", paths[i]);
+            status = 1;
+            continue;
+        }
+        status |= process_file(file, mode, &pool);
+        fclose(file);
+    }
+    fflush(stdout);
+    if (mode != MODE_STREAM) {
+        pool_destroy(&pool);
+    }
+    return status;
+}
+
+// Без аргументов проверяются встроенные примеры.
+// -p: строки файла проверяются параллельно; -s: каждый длинный ряд суммируется по частям параллельно;
+// -j N: число потоков (по умолчанию по числу процессоров).
+int main(int argc, char **argv) {
+    RunMode mode = MODE_STREAM;
+    int threads = 0;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] != '\0'; arg++) {
+        if (strcmp(argv[arg], "-p") == 0) {
+            mode = MODE_LINES;
+        } else if (strcmp(argv[arg], "-s") == 0) {
+            mode = MODE_SPLIT;
+        } else if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc) {
+            threads = atoi(argv[++arg]);
+        } else {
+            fprintf(stderr, "Использование: %s [-p | -s] [-j потоки] [файл | -]...\n", argv[0]);
+            return 1;
+        }
+    }
+    if (arg < argc) {
+        return run_files(argc - arg, argv + arg, mode, threads);
+    }
+    if (arg > 1) {
+        fprintf(stderr, "Использование: %s [-p | -s] [-j потоки] [файл | -]...\n", argv[0]);
+        return 1;
+    }
+
     const char *valid_series = "1 + 1/(2*3) + 1/(10*5)";
     const char *invalid_series = "1 + 1/(10*5) + 1/(2*579465612786526758178457124675824781)";
     const char *second_valid_series = "1 + 1/(2*3) + 1/(12321*6526) + 1/(54*123) + 1/(1*1)";
@@ -234,3 +919,4 @@ int main() {
 
     return 0;
 }
+#endif
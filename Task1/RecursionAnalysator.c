@@ -4,70 +4,145 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <pthread.h>
+
+#include "analyzers.h"
+#include "reader.h"
+#include "series_scan.h"
+
+#define WRITE_BUFFER (1 << 16)
+#define MAX_DIGITS 20
+#define SIEVE_LIMIT (1 << 16)
+#define MAX_FACTORS 16
+#define FACTOR_CACHE_SIZE 4096
+
+// Разложение на простые множители: простые числа по возрастанию и их степени
+typedef struct {
+    int count;
+    int primes[MAX_FACTORS];
+    int exponents[MAX_FACTORS];
+} Factorization;
+
+// Сумма со знаменателем, хранящимся вместе с разложением: den = П primes[i]^exponents[i].
+// den - НОК знаменателей слагаемых, поэтому НОД не нужен на каждом шаге, дробь сокращается в конце.
+typedef struct {
+    Factorization den_factors;
+    long long den;
+    long long num;
+} FactoredSum;
 
 typedef struct {
-    const char *input;
-    int pos;
+    int value;
+    Factorization factors;
+} FactorCacheEntry;
+
+// Кэш разложений с прямым отображением: в рядах одни и те же a и b встречаются многократно.
+// Принадлежит одному разбору, поэтому разборы в разных потоках его не делят.
+typedef struct {
+    FactorCacheEntry entries[FACTOR_CACHE_SIZE];
+} FactorCache;
+
+typedef struct {
+    Reader *in;
+    size_t pos;
     bool error;
     char error_msg[256];
     long long sum_num;
     long long sum_den;
+    bool overflow;
+    bool factored;
+    FactoredSum factored_sum;
+    FactorCache *factor_cache; // NULL - разложения не кэшируются
 } Parser;
 
-void skip_whitespace(Parser *p) {
-    while (p->input[p->pos] != '\0' && isspace(p->input[p->pos])) {
-        p->pos++;
+static int smallest_factor[SIEVE_LIMIT];
+static int sieve_primes[SIEVE_LIMIT];
+static int sieve_prime_count;
+static pthread_once_t sieve_once = PTHREAD_ONCE_INIT;
+
+static char peek(Parser *p, int k) {
+    return series_peek(p->in, k);
+}
+
+static void bump(Parser *p) {
+    p->in->cur++;
+    p->pos++;
+}
+
+static void bump_n(Parser *p, int n) {
+    p->in->cur += n;
+    p->pos += n;
+}
+
+static void skip_whitespace(Parser *p) {
+    while (peek(p, 0) != '\0' && isspace(peek(p, 0))) {
+        bump(p);
     }
 }
 
-bool expect(Parser *p, char expected) {
+static bool expect(Parser *p, char expected) {
     skip_whitespace(p);
-    if (p->input[p->pos] != expected) {
+    if (peek(p, 0) != expected) {
+        char found[8];
         snprintf(p->error_msg, sizeof(p->error_msg),
-                 "Ошибка: Ожидалось '%c', но найдено '%c' (позиция %d)",
-                 expected, p->input[p->pos], p->pos);
+                 "Ошибка: Ожидалось '%c', но найдено %s (позиция %zu)",
+                 expected, reader_char_text(p->in, 0, found, sizeof(found)), p->pos);
         p->error = true;
         return false;
     }
-    p->pos++;
+    bump(p);
     return true;
 }
 
-bool parse_natural(Parser *p, int *result) {
+static bool parse_natural(Parser *p, int *result) {
     skip_whitespace(p);
-    if (!isdigit(p->input[p->pos])) {
+    if (!isdigit(peek(p, 0))) {
         snprintf(p->error_msg, sizeof(p->error_msg),
-                 "Ошибка: Ожидалось натуральное число (позиция %d)", p->pos);
+                 "Ошибка: Ожидалось натуральное число (позиция %zu)", p->pos);
         p->error = true;
         return false;
     }
-    int start_pos = p->pos;
-    while (isdigit(p->input[p->pos])) {
-        p->pos++;
+    size_t start_pos = p->pos;
+    bool leading_zero = peek(p, 0) == '0';
+
+    // Первые до 8 цифр разбираются одним словом, остальные по одной.
+    // Когда значение превысило INT_MAX, цифры только считаются: длина нужна для сообщения об ошибке.
+    size_t available;
+    const char *digits = reader_window(p->in, 8, &available);
+    int head;
+    bump_n(p, parse_digits_swar(digits, available, &head));
+    long long num = head;
+    while (isdigit(peek(p, 0))) {
+        if (num <= INT_MAX) {
+            num = num * 10 + (peek(p, 0) - '0');
+        }
+        bump(p);
     }
 
-    if (p->pos - start_pos > 1 && p->input[start_pos] == '0') {
+    if (p->pos - start_pos > 1 && leading_zero) {
         snprintf(p->error_msg, sizeof(p->error_msg),
-                "Ошибка: Натуральное число не может начинаться с '0' (позиция %d)", start_pos);
+                "Ошибка: Натуральное число не может начинаться с '0' (позиция %zu)", start_pos);
         p->error = true;
         return false;
     }
 
-    char num_str[20];
-    int len = p->pos - start_pos;
-    if (len >= (int)sizeof(num_str)) {
+    size_t len = p->pos - start_pos;
+    if (len >= MAX_DIGITS) {
         snprintf(p->error_msg, sizeof(p->error_msg),
-                "Ошибка: Число слишком длинное (позиция %d)", start_pos);
+                "Ошибка: Число слишком длинное (позиция %zu)", start_pos);
         p->error = true;
         return false;
     }
-    strncpy(num_str, p->input + start_pos, len);
-    num_str[len] = '\0';
-
-    long long num = atoll(num_str);
     if (num > INT_MAX) {
         snprintf(p->error_msg, sizeof(p->error_msg),
-                "Ошибка: Число превышает максимальное значение int (позиция %d)", start_pos);
+                "Ошибка: Число превышает максимальное значение int (позиция %zu)", start_pos);
+        p->error = true;
+        return false;
+    }
+
+    if (num == 0) {
+        snprintf(p->error_msg, sizeof(p->error_msg),
+                "Ошибка: Ожидалось натуральное число ≥1 (позиция %zu)", start_pos);
         p->error = true;
         return false;
     }
@@ -76,7 +151,7 @@ bool parse_natural(Parser *p, int *result) {
     return true;
 }
 
-long long compute_gcd(long long a, long long b) {
+static long long compute_gcd(long long a, long long b) {
     while (b != 0) {
         long long temp = b;
         b = a % b;
@@ -85,7 +160,149 @@ long long compute_gcd(long long a, long long b) {
     return a;
 }
 
-bool parse_fraction(Parser *p, int *a, int *b) {
+// Решето наименьших простых делителей до SIEVE_LIMIT; его простых хватает для любого int (SIEVE_LIMIT^2 > INT_MAX).
+// Строится один раз через pthread_once, дальше только читается.
+static void build_sieve(void) {
+    for (int i = 2; i < SIEVE_LIMIT; i++) {
+        if (smallest_factor[i] != 0) continue;
+        sieve_primes[sieve_prime_count++] = i;
+        for (int j = i; j < SIEVE_LIMIT; j += i) {
+            if (smallest_factor[j] == 0) {
+                smallest_factor[j] = i;
+            }
+        }
+    }
+}
+
+static void push_factor(Factorization *f, int prime, int exponent) {
+    for (int i = 0; i < f->count; i++) {
+        if (f->primes[i] == prime) {
+            f->exponents[i] += exponent;
+            return;
+        }
+    }
+    f->primes[f->count] = prime;
+    f->exponents[f->count] = exponent;
+    f->count++;
+}
+
+static void factorize(int n, Factorization *f) {
+    f->count = 0;
+    for (int i = 0; n >= SIEVE_LIMIT && i < sieve_prime_count; i++) {
+        int prime = sieve_primes[i];
+        if ((long long)prime * prime > n) break;
+        while (n % prime == 0) {
+            push_factor(f, prime, 1);
+            n /= prime;
+        }
+    }
+    if (n >= SIEVE_LIMIT) {
+        push_factor(f, n, 1);
+        return;
+    }
+    while (n > 1) {
+        push_factor(f, smallest_factor[n], 1);
+        n /= smallest_factor[n];
+    }
+}
+
+// Разложение n из кэша; без кэша n раскладывается в scratch
+static const Factorization *cached_factors(FactorCache *cache, int n, Factorization *scratch) {
+    if (!cache) {
+        factorize(n, scratch);
+        return scratch;
+    }
+    FactorCacheEntry *entry = &cache->entries[(((unsigned)n * 2654435761u) >> 20) & (FACTOR_CACHE_SIZE - 1)];
+    if (entry->value != n) {
+        factorize(n, &entry->factors);
+        entry->value = n;
+    }
+    return &entry->factors;
+}
+
+static void factored_init(FactoredSum *sum) {
+    pthread_once(&sieve_once, build_sieve);
+    sum->den_factors.count = 0;
+    sum->den = 1;
+    sum->num = 1;
+}
+
+// sum += 1/(a*b). Если a*b делит текущий знаменатель, хватает одного деления и сложения.
+// Иначе знаменатель расширяется до НОК по максимуму степеней, а числитель умножается на тот же множитель.
+static bool factored_add(FactoredSum *sum, FactorCache *cache, int a, int b) {
+    long long d = (long long)a * b;
+    if (sum->den % d != 0) {
+        Factorization scratch;
+        Factorization term = *cached_factors(cache, a, &scratch);
+        const Factorization *fb = cached_factors(cache, b, &scratch);
+        for (int i = 0; i < fb->count; i++) {
+            push_factor(&term, fb->primes[i], fb->exponents[i]);
+        }
+
+        long long scale = 1;
+        int missing[MAX_FACTORS];
+        for (int i = 0; i < term.count; i++) {
+            missing[i] = term.exponents[i];
+            for (int j = 0; j < sum->den_factors.count; j++) {
+                if (sum->den_factors.primes[j] == term.primes[i]) {
+                    missing[i] -= sum->den_factors.exponents[j];
+                    break;
+                }
+            }
+            for (int k = 0; k < missing[i]; k++) {
+                if (scale > LLONG_MAX / term.primes[i]) return false;
+                scale *= term.primes[i];
+            }
+        }
+        if (sum->den > LLONG_MAX / scale || sum->num > LLONG_MAX / scale) return false;
+        sum->den *= scale;
+        sum->num *= scale;
+        for (int i = 0; i < term.count; i++) {
+            if (missing[i] > 0) {
+                push_factor(&sum->den_factors, term.primes[i], missing[i]);
+            }
+        }
+    }
+
+    long long addend = sum->den / d;
+    if (sum->num > LLONG_MAX - addend) return false;
+    sum->num += addend;
+    return true;
+}
+
+// Сокращение в конце: общими делителями могут быть только простые из разложения знаменателя
+static void factored_result(FactoredSum *sum, long long *num, long long *den) {
+    *num = sum->num;
+    *den = sum->den;
+    for (int i = 0; i < sum->den_factors.count; i++) {
+        int prime = sum->den_factors.primes[i];
+        for (int k = 0; k < sum->den_factors.exponents[i] && *num % prime == 0; k++) {
+            *num /= prime;
+            *den /= prime;
+        }
+    }
+}
+
+static bool add_term_gcd(Parser *p, long long d) {
+    // Проверка переполнения до умножения, включая прибавление знаменателя к числителю
+    if ((d > 0 && p->sum_den > LLONG_MAX / d) ||
+        (p->sum_num > 0 && d > LLONG_MAX / p->sum_num) ||
+        p->sum_num * d > LLONG_MAX - p->sum_den) {
+        return false;
+    }
+
+    // Вычисление нового числителя и знаменателя
+    long long new_num = p->sum_num * d + p->sum_den;
+    long long new_den = p->sum_den * d;
+
+    // Сокращение дроби
+    long long gcd = compute_gcd(new_num, new_den);
+    p->sum_num = new_num / gcd;
+    p->sum_den = new_den / gcd;
+    return true;
+}
+
+static bool parse_fraction(Parser *p, int *a, int *b) {
     if (!expect(p, '1')) return false;
     if (!expect(p, '/')) return false;
     if (!expect(p, '(')) return false;
@@ -97,7 +314,7 @@ bool parse_fraction(Parser *p, int *a, int *b) {
     long long product = (long long)(*a) * (*b);
     if (product > INT_MAX) {
         snprintf(p->error_msg, sizeof(p->error_msg),
-                 "Ошибка: Произведение %d*%d превышает максимальное значение int (позиция %d)",
+                 "Ошибка: Произведение %d*%d превышает максимальное значение int (позиция %zu)",
                  *a, *b, p->pos);
         p->error = true;
         return false;
@@ -106,53 +323,61 @@ bool parse_fraction(Parser *p, int *a, int *b) {
     return true;
 }
 
-bool parse_series(Parser *p) {
+static bool parse_series(Parser *p) {
     p->sum_num = 1;
     p->sum_den = 1;
 
+    if (p->factored) factored_init(&p->factored_sum);
+
     if (!expect(p, '1')) return false;
 
     skip_whitespace(p);
 
-    while (p->input[p->pos] == '+') {
-        p->pos++;
+    while (peek(p, 0) == '+') {
+        bump(p);
         int a, b;
         if (!parse_fraction(p, &a, &b)) return false;
-        long long d = (long long)a * b;
-
-        // Вычисление нового числителя и знаменателя
-        long long new_num = p->sum_num * d + p->sum_den;
-        long long new_den = p->sum_den * d;
-
-        // Проверка переполнения
-        if ((d > 0 && p->sum_den > LLONG_MAX / d) ||
-            (p->sum_num > 0 && d > LLONG_MAX / p->sum_num)) {
+        bool added = p->factored ? factored_add(&p->factored_sum, p->factor_cache, a, b)
+                                 : add_term_gcd(p, (long long)a * b);
+        if (!added) {
             snprintf(p->error_msg, sizeof(p->error_msg),
-                     "Ошибка: Переполнение при вычислении суммы (позиция %d)", p->pos);
+                     "Ошибка: Переполнение при вычислении суммы (позиция %zu)", p->pos);
             p->error = true;
+            p->overflow = true;
             return false;
         }
 
-        // Сокращение дроби
-        long long gcd = compute_gcd(new_num, new_den);
-        p->sum_num = new_num / gcd;
-        p->sum_den = new_den / gcd;
-
         skip_whitespace(p);
     }
 
-    if (p->input[p->pos] != '\0') {
+    if (peek(p, 0) != '\0' || !reader_at_line_end(p->in, 0)) {
+        char found[8];
         snprintf(p->error_msg, sizeof(p->error_msg),
-                 "Ошибка: Неожиданный символ '%c' (позиция %d)",
-                 p->input[p->pos], p->pos);
+                 "Ошибка: Неожиданный символ %s (позиция %zu)",
+                 reader_char_text(p->in, 0, found, sizeof(found)), p->pos);
         p->error = true;
         return false;
     }
+    if (p->factored) factored_result(&p->factored_sum, &p->sum_num, &p->sum_den);
     return true;
 }
 
-void parse(const char *input) {
-    Parser p = {input, 0, false, "", 0, 0};
+// Отдельный ряд разбирается без кэша разложений: общего изменяемого состояния нет,
+// так что функцию можно вызывать из нескольких потоков
+void rd_check_series(const char *series, size_t len, bool factored, SeriesResult *result) {
+    Reader in;
+    reader_from_buffer(&in, series, len);
+    Parser p = {.in = &in, .factored = factored};
+    bool ok = parse_series(&p);
+    result->verdict = ok ? SERIES_OK : p.overflow ? SERIES_OVERFLOW : SERIES_SYNTAX_ERROR;
+    result->num = p.sum_num;
+    result->den = p.sum_den;
+    snprintf(result->error_msg, sizeof(result->error_msg), "%s", ok ? "" : p.error_msg);
+}
+
+#ifndef ANALYZER_LIBRARY
+static void parse_reader(Reader *in, bool factored, FactorCache *cache) {
+    Parser p = {.in = in, .factored = factored, .factor_cache = cache};
     if (parse_series(&p)) {
         printf("✅ Корректный ряд! Сумма: %lld/%lld\n", p.sum_num, p.sum_den);
     } else {
@@ -160,7 +385,75 @@ void parse(const char *input) {
     }
 }
 
-int main() {
+static void parse(const char *input) {
+    Reader in;
+    reader_from_string(&in, input);
+    parse_reader(&in, false, NULL);
+}
+
+// Потоковый режим: по одному ряду на строку, по одной строке результата на ряд.
+// С -f кэш разложений общий для всех строк файла.
+static int parse_stream(FILE *file, bool factored) {
+    Reader in;
+    FactorCache *cache = factored ? calloc(1, sizeof(FactorCache)) : NULL;
+    if ((factored && !cache) || !reader_open(&in, file)) {
+        fprintf(stderr, "Ошибка: Не удалось выделить буфер чтения\n");
+        free(cache);
+        return 1;
+    }
+    while (!reader_at_end(&in)) {
+        parse_reader(&in, factored, cache);
+        reader_next_line(&in);
+    }
+    reader_close(&in);
+    free(cache);
+    return ferror(file) ? 1 : 0;
+}
+
+static int run_files(int count, char **paths, bool factored) {
+    static char out_buffer[WRITE_BUFFER];
+    setvbuf(stdout, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    int status = 0;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(paths[i], "-") == 0) {
+            status |= parse_stream(stdin, factored);
+            continue;
+        }
+        FILE *file = fopen(paths[i], "rb");
+        if (!file) {
+            fprintf(stderr, "Ошибка: Не удалось открыть файл %s\n", paths[i]);
+            status = 1;
+            continue;
+        }
+        status |= parse_stream(file, factored);
+        fclose(file);
+    }
+    fflush(stdout);
+    return status;
+}
+
+// Без аргументов проверяются встроенные примеры.
+// -f: суммировать через разложение знаменателя (factored_add) вместо НОД на каждом шаге.
+int main(int argc, char **argv) {
+    bool factored = false;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] != '\0'; arg++) {
+        if (strcmp(argv[arg], "-f") == 0) {
+            factored = true;
+        } else {
+            fprintf(stderr, "Использование: %s [-f] [файл | -]...\n", argv[0]);
+            return 1;
+        }
+    }
+    if (arg < argc) {
+        return run_files(argc - arg, argv + arg, factored);
+    }
+    if (arg > 1) {
+        fprintf(stderr, "Использование: %s [-f] [файл | -]...\n", argv[0]);
+        return 1;
+    }
+
     const char *valid_series = "1 + 1/(2*3) + 1/(10*5)";
     const char *invalid_series = "1 + 1/(10*5) + 1/(2*579465612786526758178457124675824781)";
     const char *second_valid_series = "1 + 1/(2*3) + 1/(12321*6526) + 1/(54*123) + 1/(1*1)";
@@ -176,3 +469,4 @@ int main() {
 
     return 0;
 }
+#endif
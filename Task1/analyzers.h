@@ -0,0 +1,32 @@
+#ifndef TASK1_ANALYZERS_H
+#define TASK1_ANALYZERS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Точки входа анализаторов для вызова из одного процесса (Task1/harness.c).
+// Сами анализаторы при этом собираются с -DANALYZER_LIBRARY, чтобы не тянуть свои main.
+// Общее состояние (таблица разбора LL, решето простых) строится один раз через pthread_once,
+// поэтому функции можно вызывать из нескольких потоков одновременно.
+
+typedef enum {
+    SERIES_OK,
+    SERIES_SYNTAX_ERROR,
+    SERIES_OVERFLOW
+} SeriesVerdict;
+
+typedef struct {
+    SeriesVerdict verdict;
+    long long num;
+    long long den;
+    char error_msg[256];
+} SeriesResult;
+
+// Ряд "1 + 1/(a*b) + ..." из len байт без завершающего '\n'
+void ll_check_series(const char *series, size_t len, SeriesResult *result);
+void rd_check_series(const char *series, size_t len, bool factored, SeriesResult *result);
+
+// Выражение "a/b + c/d + ..." в грамматике version1.c; переполнение int там не отслеживается
+void v1_evaluate(const char *expression, size_t len, SeriesResult *result);
+
+#endif
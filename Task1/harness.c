@@ -0,0 +1,399 @@
+// Дифференциальный стенд для трёх анализаторов Task1.
+// Генерирует корректные и почти корректные ряды, прогоняет каждый через все реализации в одном процессе,
+// сверяет вердикты и суммы и печатает производительность каждой реализации.
+//
+// Сборка (из каталога Task1):
+//   gcc -O2 -pthread -DANALYZER_LIBRARY harness.c LLAnalysator.c RecursionAnalysator.c version1.c -o harness
+//
+// Параметры:
+//   -n N   число рядов (по умолчанию 100000)
+//   -t N   наибольшее число слагаемых в ряду (по умолчанию 8)
+//   -d N   наибольшее число цифр в a и b (по умолчанию 4)
+//   -m N   доля почти корректных рядов в процентах (по умолчанию 30)
+//   -s N   зерно генератора (по умолчанию 1)
+//
+// version1.c разбирает другую запись ("a/b + c/d"), поэтому ему передаётся корректный ряд,
+// переписанный как "1/1 + 1/(a*b) + ...", и только если его арифметика int не переполняется.
+// Код возврата 1, если найдено хоть одно расхождение.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+
+#include "analyzers.h"
+
+#define MAX_REPORTED 5
+#define MUTATION_ALPHABET "0123456789+/()* x"
+
+typedef struct {
+    char *data;
+    size_t len;
+    size_t capacity;
+} Text;
+
+typedef struct {
+    const char *name;
+    uint64_t *latencies;
+    size_t count;
+    size_t bytes;
+    uint64_t total_ns;
+} EngineStats;
+
+typedef enum {
+    ENGINE_LL, ENGINE_RD, ENGINE_RD_FACTORED, ENGINE_V1, ENGINE_COUNT
+} Engine;
+
+typedef struct {
+    int series;
+    int terms;
+    int digits;
+    int mutate_percent;
+    uint64_t seed;
+} Options;
+
+static uint64_t rng_state;
+
+static uint64_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static long long random_range(long long low, long long high) {
+    return low + (long long)(next_random() % (uint64_t)(high - low + 1));
+}
+
+static void text_reserve(Text *t, size_t extra) {
+    if (t->len + extra + 1 <= t->capacity) return;
+    size_t capacity = t->capacity ? t->capacity : 256;
+    while (capacity < t->len + extra + 1) capacity *= 2;
+    t->data = realloc(t->data, capacity);
+    if (!t->data) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память\n");
+        exit(1);
+    }
+    t->capacity = capacity;
+}
+
+static void text_append(Text *t, const char *s) {
+    size_t n = strlen(s);
+    text_reserve(t, n);
+    memcpy(t->data + t->len, s, n + 1);
+    t->len += n;
+}
+
+static void text_insert(Text *t, size_t pos, char c) {
+    text_reserve(t, 1);
+    memmove(t->data + pos + 1, t->data + pos, t->len - pos + 1);
+    t->data[pos] = c;
+    t->len++;
+}
+
+static void text_erase(Text *t, size_t pos, size_t n) {
+    memmove(t->data + pos, t->data + pos + n, t->len - pos - n + 1);
+    t->len -= n;
+}
+
+// Натуральное число не больше limit, в котором от 1 до digits цифр
+static long long random_natural(int digits, long long limit) {
+    long long high = 9;
+    int count = (int)random_range(1, digits);
+    for (int i = 1; i < count && high <= LLONG_MAX / 10; i++) {
+        high = high * 10 + 9;
+    }
+    if (high > limit) high = limit;
+    return random_range(count > 1 && high >= 10 ? (high + 1) / 10 : 1, high);
+}
+
+// Корректный ряд "1 + 1/(a*b) + ..." и та же сумма в записи version1 ("1/1 + 1/d + ...").
+// v1_comparable сбрасывается, если промежуточные числители или знаменатели version1 не помещаются в int.
+static void generate_series(const Options *opt, Text *series, Text *v1, bool *v1_comparable) {
+    series->len = 0;
+    v1->len = 0;
+    text_append(series, "1");
+    text_append(v1, "1/1");
+    long long num = 1;
+    long long den = 1;
+    *v1_comparable = true;
+
+    int terms = (int)random_range(0, opt->terms);
+    char term[64];
+    for (int i = 0; i < terms; i++) {
+        long long a = random_natural(opt->digits, INT_MAX);
+        long long b = random_natural(opt->digits, INT_MAX / a);
+        text_append(series, next_random() % 4 == 0 ? "+" : " + ");
+        snprintf(term, sizeof(term), "1/(%lld*%lld)", a, b);
+        text_append(series, term);
+        snprintf(term, sizeof(term), " + 1/%lld", a * b);
+        text_append(v1, term);
+
+        // Та же арифметика, что в add_fractions из version1.c, но с проверкой границ int
+        if (*v1_comparable) {
+            num = num * (a * b) + den;
+            den = den * (a * b);
+            if (num > INT_MAX || den > INT_MAX) {
+                *v1_comparable = false;
+            }
+        }
+    }
+}
+
+static size_t find_digit(const Text *t) {
+    size_t start = (size_t)random_range(0, t->len - 1);
+    for (size_t i = 0; i < t->len; i++) {
+        size_t pos = (start + i) % t->len;
+        if (t->data[pos] >= '0' && t->data[pos] <= '9') {
+            while (pos > 0 && t->data[pos - 1] >= '0' && t->data[pos - 1] <= '9') pos--;
+            return pos;
+        }
+    }
+    return t->len;
+}
+
+// Одна мелкая порча корректного ряда: лишний, пропущенный или заменённый символ, ноль, ведущий ноль,
+// число больше INT_MAX, сдвоенный '+' или обрыв строки
+static void mutate_series(Text *t) {
+    const char *alphabet = MUTATION_ALPHABET;
+    size_t alphabet_len = strlen(alphabet);
+    size_t pos = (size_t)random_range(0, t->len - 1);
+    size_t number = find_digit(t);
+    switch (next_random() % 8) {
+        case 0:
+            text_erase(t, pos, 1);
+            break;
+        case 1:
+            text_insert(t, pos, alphabet[next_random() % alphabet_len]);
+            break;
+        case 2:
+            t->data[pos] = alphabet[next_random() % alphabet_len];
+            break;
+        case 3:
+            if (number < t->len) {
+                while (number < t->len && t->data[number] >= '0' && t->data[number] <= '9') {
+                    text_erase(t, number, 1);
+                }
+                text_insert(t, number, '0');
+            }
+            break;
+        case 4:
+            if (number < t->len) text_insert(t, number, '0');
+            break;
+        case 5:
+            if (number < t->len) {
+                for (int i = 0; i < 10; i++) text_insert(t, number, '9');
+            }
+            break;
+        case 6:
+            for (size_t i = 0; i < t->len; i++) {
+                if (t->data[i] == '+') {
+                    text_insert(t, i, '+');
+                    break;
+                }
+            }
+            break;
+        default:
+            t->len = pos;
+            t->data[pos] = '\0';
+            break;
+    }
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void run_engine(Engine engine, EngineStats *stats, const Text *input, SeriesResult *result) {
+    uint64_t start = now_ns();
+    switch (engine) {
+        case ENGINE_LL: ll_check_series(input->data, input->len, result); break;
+        case ENGINE_RD: rd_check_series(input->data, input->len, false, result); break;
+        case ENGINE_RD_FACTORED: rd_check_series(input->data, input->len, true, result); break;
+        default: v1_evaluate(input->data, input->len, result); break;
+    }
+    uint64_t elapsed = now_ns() - start;
+    stats->latencies[stats->count++] = elapsed;
+    stats->total_ns += elapsed;
+    stats->bytes += input->len;
+}
+
+static const char *verdict_name(SeriesVerdict verdict) {
+    switch (verdict) {
+        case SERIES_OK: return "корректен";
+        case SERIES_OVERFLOW: return "переполнение";
+        default: return "ошибка разбора";
+    }
+}
+
+// printf выравнивает по байтам, а названия в UTF-8; ширина здесь считается в символах
+static void print_cell(const char *s, int width, bool left) {
+    int chars = 0;
+    for (const char *c = s; *c; c++) {
+        chars += ((unsigned char)*c & 0xC0) != 0x80;
+    }
+    int pad = width > chars ? width - chars : 0;
+    if (left) {
+        printf("%s%*s", s, pad, "");
+    } else {
+        printf("%*s%s", pad, "", s);
+    }
+}
+
+static void report_mismatch(int *reported, const char *what, const Text *input,
+                            const char *left_name, const SeriesResult *left,
+                            const char *right_name, const SeriesResult *right) {
+    if (++*reported > MAX_REPORTED) return;
+    printf("Расхождение (%s) на входе: %.200s%s\n", what, input->data, input->len > 200 ? "..." : "");
+    printf("  ");
+    print_cell(left_name, 24, true);
+    printf(" %s %lld/%lld %s\n", verdict_name(left->verdict), left->num, left->den, left->error_msg);
+    printf("  ");
+    print_cell(right_name, 24, true);
+    printf(" %s %lld/%lld %s\n", verdict_name(right->verdict), right->num, right->den, right->error_msg);
+}
+
+// Сравнивает ответ реализации с ответом LLAnalysator. Если переполнилась хотя бы одна,
+// ряд только учитывается: проверки переполнения у реализаций разные, и разбор останавливается
+// в разных местах. В остальных случаях должны совпасть вердикт и сумма.
+static bool compare_results(const char *name, const SeriesResult *ll, const SeriesResult *other,
+                            const Text *input, int *reported, long *overflow_only) {
+    if (ll->verdict == SERIES_OVERFLOW || other->verdict == SERIES_OVERFLOW) {
+        *overflow_only += ll->verdict != other->verdict;
+        return true;
+    }
+    if (ll->verdict != other->verdict) {
+        report_mismatch(reported, "вердикт", input, "LLAnalysator", ll, name, other);
+        return false;
+    }
+    if (ll->verdict == SERIES_OK && (ll->num != other->num || ll->den != other->den)) {
+        report_mismatch(reported, "сумма", input, "LLAnalysator", ll, name, other);
+        return false;
+    }
+    return true;
+}
+
+static int compare_latency(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static double percentile_us(const uint64_t *sorted, size_t count, double p) {
+    size_t index = (size_t)(p * count);
+    if (index >= count) index = count - 1;
+    return sorted[index] / 1000.0;
+}
+
+static void print_stats(EngineStats *stats) {
+    print_cell(stats->name, 24, true);
+    if (stats->count == 0) {
+        printf(" нет запусков\n");
+        return;
+    }
+    qsort(stats->latencies, stats->count, sizeof(uint64_t), compare_latency);
+    double seconds = stats->total_ns / 1e9;
+    printf(" %9zu %9.2f %9.1f %10.0f %8.2f %8.2f %8.2f %9.2f\n",
+           stats->count, stats->bytes / 1e6,
+           seconds > 0 ? stats->bytes / 1e6 / seconds : 0.0,
+           seconds > 0 ? stats->count / seconds : 0.0,
+           percentile_us(stats->latencies, stats->count, 0.50),
+           percentile_us(stats->latencies, stats->count, 0.90),
+           percentile_us(stats->latencies, stats->count, 0.99),
+           stats->latencies[stats->count - 1] / 1000.0);
+}
+
+static bool parse_options(int argc, char **argv, Options *opt) {
+    *opt = (Options){100000, 8, 4, 30, 1};
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc || argv[i][0] != '-' || argv[i][1] == '\0' || argv[i][2] != '\0') return false;
+        long long value = atoll(argv[++i]);
+        switch (argv[i - 1][1]) {
+            case 'n': opt->series = (int)value; break;
+            case 't': opt->terms = (int)value; break;
+            case 'd': opt->digits = (int)value; break;
+            case 'm': opt->mutate_percent = (int)value; break;
+            case 's': opt->seed = (uint64_t)value; break;
+            default: return false;
+        }
+    }
+    return opt->series > 0 && opt->terms >= 0 && opt->digits > 0 && opt->digits <= 18 &&
+           opt->mutate_percent >= 0 && opt->mutate_percent <= 100;
+}
+
+int main(int argc, char **argv) {
+    Options opt;
+    if (!parse_options(argc, argv, &opt)) {
+        fprintf(stderr, "Использование: %s [-n рядов] [-t слагаемых] [-d цифр] [-m %%порчи] [-s зерно]\n", argv[0]);
+        return 1;
+    }
+    rng_state = opt.seed ? opt.seed : 1;
+
+    const char *names[ENGINE_COUNT] = {"LLAnalysator", "RecursionAnalysator", "RecursionAnalysator -f", "version1"};
+    EngineStats stats[ENGINE_COUNT];
+    for (int e = 0; e < ENGINE_COUNT; e++) {
+        stats[e] = (EngineStats){names[e], malloc(opt.series * sizeof(uint64_t)), 0, 0, 0};
+        if (!stats[e].latencies) {
+            fprintf(stderr, "Ошибка: Не удалось выделить память\n");
+            return 1;
+        }
+    }
+
+    Text series = {0};
+    Text v1 = {0};
+    long mutated = 0, accepted = 0, v1_skipped = 0, overflow_only = 0, mismatches = 0;
+    int reported = 0;
+    for (int i = 0; i < opt.series; i++) {
+        bool v1_comparable;
+        generate_series(&opt, &series, &v1, &v1_comparable);
+        bool mutate = random_range(1, 100) <= opt.mutate_percent;
+        if (mutate) {
+            mutate_series(&series);
+            mutated++;
+        }
+
+        SeriesResult ll, rd, rd_factored, v1_result;
+        run_engine(ENGINE_LL, &stats[ENGINE_LL], &series, &ll);
+        run_engine(ENGINE_RD, &stats[ENGINE_RD], &series, &rd);
+        run_engine(ENGINE_RD_FACTORED, &stats[ENGINE_RD_FACTORED], &series, &rd_factored);
+        accepted += ll.verdict == SERIES_OK;
+
+        mismatches += !compare_results(names[ENGINE_RD], &ll, &rd, &series, &reported, &overflow_only);
+        mismatches += !compare_results(names[ENGINE_RD_FACTORED], &ll, &rd_factored, &series, &reported,
+                                       &overflow_only);
+
+        if (mutate || !v1_comparable || ll.verdict != SERIES_OK) {
+            v1_skipped++;
+            continue;
+        }
+        run_engine(ENGINE_V1, &stats[ENGINE_V1], &v1, &v1_result);
+        if (v1_result.verdict != SERIES_OK || v1_result.num != ll.num || v1_result.den != ll.den) {
+            report_mismatch(&reported, "version1", &v1, names[ENGINE_LL], &ll, names[ENGINE_V1], &v1_result);
+            mismatches++;
+        }
+    }
+
+    printf("Рядов: %d (испорчено %ld, LLAnalysator принял %ld), version1 пропущен: %ld\n",
+           opt.series, mutated, accepted, v1_skipped);
+    printf("Разный предел переполнения: %ld, расхождений: %ld%s\n\n",
+           overflow_only, mismatches, reported > MAX_REPORTED ? " (показаны первые)" : "");
+    const char *columns[] = {"рядов", "МБ", "МБ/с", "рядов/с", "p50 мкс", "p90 мкс", "p99 мкс", "max мкс"};
+    const int widths[] = {9, 9, 9, 10, 8, 8, 8, 9};
+    print_cell("реализация", 24, true);
+    for (int c = 0; c < 8; c++) {
+        printf(" ");
+        print_cell(columns[c], widths[c], false);
+    }
+    printf("\n");
+    for (int e = 0; e < ENGINE_COUNT; e++) {
+        print_stats(&stats[e]);
+        free(stats[e].latencies);
+    }
+    free(series.data);
+    free(v1.data);
+    return mismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+#ifndef TASK1_READER_H
+#define TASK1_READER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#define READ_CHUNK (1 << 16)
+
+// Источник символов: строка в памяти или файл, читаемый блоками по READ_CHUNK байт.
+// Ряд (или выражение version1.c) заканчивается на '\n' или в конце данных,
+// поэтому в файле их может быть сколько угодно.
+typedef struct {
+    FILE *file;
+    const char *data;
+    char *storage;
+    size_t len;
+    size_t cur;
+    size_t checked; // data[cur..checked) уже проверены предпроходом (series_scan.h)
+    bool eof;
+} Reader;
+
+static inline void reader_from_buffer(Reader *r, const char *s, size_t len) {
+    r->file = NULL;
+    r->data = s;
+    r->storage = NULL;
+    r->len = len;
+    r->cur = 0;
+    r->checked = 0;
+    r->eof = true;
+}
+
+static inline void reader_from_string(Reader *r, const char *s) {
+    reader_from_buffer(r, s, strlen(s));
+}
+
+static inline bool reader_open(Reader *r, FILE *file) {
+    r->file = file;
+    r->storage = malloc(READ_CHUNK);
+    r->data = r->storage;
+    r->len = 0;
+    r->cur = 0;
+    r->checked = 0;
+    r->eof = false;
+    return r->storage != NULL;
+}
+
+static inline void reader_close(Reader *r) {
+    free(r->storage);
+    r->storage = NULL;
+}
+
+// Сдвигает непрочитанный остаток в начало буфера и дочитывает следующий блок.
+static inline void reader_fill(Reader *r) {
+    size_t rest = r->len - r->cur;
+    memmove(r->storage, r->storage + r->cur, rest);
+    r->checked = r->checked > r->cur ? r->checked - r->cur : 0;
+    r->len = rest;
+    r->cur = 0;
+    r->len += fread(r->storage + rest, 1, READ_CHUNK - rest, r->file);
+    if (r->len < READ_CHUNK) {
+        r->eof = true;
+    }
+}
+
+static inline char reader_peek(Reader *r, size_t k) {
+    if (r->cur + k >= r->len && !r->eof) {
+        reader_fill(r);
+    }
+    if (r->cur + k >= r->len) {
+        return '\0';
+    }
+    return r->data[r->cur + k];
+}
+
+static inline bool reader_at_end(Reader *r) {
+    reader_peek(r, 0);
+    return r->cur >= r->len;
+}
+
+// Пропускает остаток текущей строки вместе с '\n'.
+static inline void reader_next_line(Reader *r) {
+    while (!reader_at_end(r)) {
+        if (r->data[r->cur++] == '\n') {
+            break;
+        }
+    }
+}
+
+// Ряд кончается только на '\n' или в конце данных; байт NUL внутри строки - обычный посторонний символ.
+static inline bool reader_at_line_end(Reader *r, size_t k) {
+    return reader_peek(r, k) == '\n' || r->cur + k >= r->len;
+}
+
+// Символ k для сообщений об ошибках: "конец строки" для '\n' и конца данных, иначе символ в кавычках.
+// Байт NUL печатается как '\0', чтобы не обрывать строку сообщения.
+static inline const char *reader_char_text(Reader *r, size_t k, char *buffer, size_t size) {
+    if (reader_at_line_end(r, k)) {
+        return "конец строки";
+    }
+    char c = reader_peek(r, k);
+    if (c == '\0') {
+        return "'\\0'";
+    }
+    snprintf(buffer, size, "'%c'", c);
+    return buffer;
+}
+
+// Гарантирует, что в буфере лежит не меньше want байт (если данные не кончились), и возвращает их
+static inline const char *reader_window(Reader *r, size_t want, size_t *available) {
+    if (r->len - r->cur < want && !r->eof) {
+        reader_fill(r);
+    }
+    *available = r->len - r->cur;
+    return r->data + r->cur;
+}
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef TASK1_SERIES_SCAN_H
+#define TASK1_SERIES_SCAN_H
+
+#include <ctype.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "reader.h"
+
+// Побайтовые примитивы, общие для LLAnalysator.c и RecursionAnalysator.c:
+// разбор цифр словом и предварительная проверка байтов ряда.
+
+// Разбирает до 8 цифр с начала s одним 64-битным словом (SWAR) и возвращает их количество.
+// Байт - цифра, если его старшая тетрада равна 3 и не меняется после прибавления 6 к младшей.
+static inline int parse_digits_swar(const char *s, size_t available, int *value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t word = 0;
+    memcpy(&word, s, available < 8 ? available : 8);
+    uint64_t high = word & 0xF0F0F0F0F0F0F0F0ULL;
+    uint64_t carry = (word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL;
+    uint64_t foreign = (high ^ 0x3030303030303030ULL) | (carry ^ 0x3030303030303030ULL);
+    int count = foreign ? __builtin_ctzll(foreign) / 8 : 8;
+    if (count == 0) {
+        *value = 0;
+        return 0;
+    }
+    // Цифры сдвигаются к старшим байтам, освободившиеся младшие байты становятся ведущими нулями
+    uint64_t digits = (word - 0x3030303030303030ULL) << (8 * (8 - count));
+    digits = digits * 10 + (digits >> 8);
+    digits = (((digits & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+              (((digits >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    *value = (int)digits;
+    return count;
+#else
+    int count = 0;
+    *value = 0;
+    while (count < 8 && (size_t)count < available && isdigit((unsigned char)s[count])) {
+        *value = *value * 10 + (s[count] - '0');
+        count++;
+    }
+    return count;
+#endif
+}
+
+static inline bool is_series_byte(unsigned char c) {
+    return (c >= '(' && c <= '9' && c != ',' && c != '-' && c != '.') ||
+           c == ' ' || (c >= '\t' && c <= '\r' && c != '\n');
+}
+
+// Индекс первого байта, которого не может быть в ряду; сюда попадают и '\n', и байт NUL.
+// С SSE2 байты классифицируются по 16 за раз.
+static inline size_t find_foreign(const char *s, size_t n) {
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i op_low = _mm_set1_epi8('(' - 1), op_high = _mm_set1_epi8('9' + 1);
+    const __m128i gap_low = _mm_set1_epi8(',' - 1), gap_high = _mm_set1_epi8('.' + 1);
+    const __m128i ws_low = _mm_set1_epi8('\t' - 1), ws_high = _mm_set1_epi8('\r' + 1);
+    const __m128i newline = _mm_set1_epi8('\n'), space = _mm_set1_epi8(' ');
+    for (; i + 16 <= n; i += 16) {
+        __m128i b = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i op = _mm_and_si128(_mm_cmpgt_epi8(b, op_low), _mm_cmplt_epi8(b, op_high));
+        __m128i gap = _mm_and_si128(_mm_cmpgt_epi8(b, gap_low), _mm_cmplt_epi8(b, gap_high));
+        __m128i ws = _mm_and_si128(_mm_cmpgt_epi8(b, ws_low), _mm_cmplt_epi8(b, ws_high));
+        ws = _mm_or_si128(_mm_andnot_si128(_mm_cmpeq_epi8(b, newline), ws), _mm_cmpeq_epi8(b, space));
+        __m128i valid = _mm_or_si128(_mm_andnot_si128(gap, op), ws);
+        int mask = ~_mm_movemask_epi8(valid) & 0xFFFF;
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        if (!is_series_byte(s[i])) {
+            return i;
+        }
+    }
+    return n;
+}
+
+// Медленный путь series_peek: продлевает проверенную часть буфера по уже прочитанным данным
+// (дочитывая блок, если байт k за концом буфера) и, если байт k всё ещё за её границей,
+// читает его обычным reader_peek. Сюда попадают только '\n', конец данных и посторонние байты,
+// поэтому ошибку по-прежнему находит сам разбор, в порядке чтения.
+// Вынесена из series_peek, чтобы быстрый путь встраивался в вызывающий код.
+__attribute__((noinline)) static char series_peek_slow(Reader *r, size_t k) {
+    if (r->checked < r->cur) {
+        r->checked = r->cur;
+    }
+    if (r->cur + k >= r->len && !r->eof) {
+        reader_fill(r);
+    }
+    r->checked += find_foreign(r->data + r->checked, r->len - r->checked);
+    if (r->cur + k < r->checked) {
+        return r->data[r->cur + k];
+    }
+    char c = reader_peek(r, k);
+    return c == '\n' ? '\0' : c;
+}
+
+// Символ ряда на k позиций вперёд, '\n' отдаётся как '\0'. Байт NUL в данных тоже приходит как '\0',
+// поэтому конец ряда по '\0' подтверждает reader_at_line_end. Внутри проверенной части буфера -
+// одно сравнение и чтение, без проверок дочитывания и конца строки на каждом байте.
+static inline char series_peek(Reader *r, size_t k) {
+    if (r->cur + k < r->checked) {
+        return r->data[r->cur + k];
+    }
+    return series_peek_slow(r, k);
+}
+
+#endif
@@ -2,27 +2,53 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#include "analyzers.h"
+#include "reader.h"
+
+#define WRITE_BUFFER (1 << 16)
+#define TOKEN_WINDOW 256
 
 typedef struct {
     int numerator;
     int denominator;
 } Fraction;
 
+typedef enum {
+    TOKEN_NUMBER, TOKEN_PLUS, TOKEN_SLASH, TOKEN_END
+} TokenType;
+
+// Токен фиксированного размера: текст не копируется, число разбирается сразу при сканировании
 typedef struct {
-    char **tokens;
+    TokenType type;
+    size_t offset;
+    int value;
+} Token;
+
+// Токены выдаются окнами в буфер вызывающего: когда парсер доходит до конца окна,
+// сканирование продолжается с того места, где остановилось, так что вход читается один раз.
+typedef struct {
+    Reader *in;
+    size_t offset;
+    Token *tokens;
+    int capacity;
     int count;
     int pos;
+    bool error;
+    char error_msg[256];
 } Tokenizer;
 
 // Функции для работы с дробями
-Fraction add_fractions(Fraction a, Fraction b) {
+static Fraction add_fractions(Fraction a, Fraction b) {
     Fraction result;
     result.numerator = a.numerator * b.denominator + b.numerator * a.denominator;
     result.denominator = a.denominator * b.denominator;
     return result;
 }
 
-int gcd(int a, int b) {
+static int gcd(int a, int b) {
     while (b != 0) {
         int temp = b;
         b = a % b;
@@ -31,7 +57,7 @@ int gcd(int a, int b) {
     return a;
 }
 
-void simplify_fraction(Fraction *f) {
+static void simplify_fraction(Fraction *f) {
     int common_divisor = gcd(abs(f->numerator), abs(f->denominator));
     f->numerator /= common_divisor;
     f->denominator /= common_divisor;
@@ -43,132 +69,269 @@ void simplify_fraction(Fraction *f) {
 }
 
 // Функции для токенизации
-Tokenizer tokenize(const char *input) {
-    Tokenizer tokenizer;
-    tokenizer.count = 0;
-    tokenizer.pos = 0;
-    
-    // Подсчет количества токенов
-    const char *p = input;
-    while (*p) {
-        while (isspace(*p)) p++;
-        if (!*p) break;
-        
-        if (*p == '+' || *p == '/') {
-            tokenizer.count++;
-            p++;
-        } else if (isdigit(*p) || (*p == '-' && isdigit(*(p+1)))) {
-            tokenizer.count++;
-            if (*p == '-') p++;
-            while (isdigit(*p)) p++;
+static void init_tokenizer(Tokenizer *tokenizer, Reader *in, Token *tokens, int capacity) {
+    tokenizer->in = in;
+    tokenizer->offset = 0;
+    tokenizer->tokens = tokens;
+    tokenizer->capacity = capacity;
+    tokenizer->count = 0;
+    tokenizer->pos = 0;
+    tokenizer->error = false;
+    tokenizer->error_msg[0] = '\0';
+}
+
+static char peek(Tokenizer *tokenizer, int k) {
+    char c = reader_peek(tokenizer->in, k);
+    return c == '\n' ? '\0' : c;
+}
+
+static void bump(Tokenizer *tokenizer) {
+    tokenizer->in->cur++;
+    tokenizer->offset++;
+}
+
+// Байт NUL печатается как \0, чтобы не обрывать строку сообщения
+static void report_unknown(Tokenizer *tokenizer, char c) {
+    if (c == '\0') {
+        snprintf(tokenizer->error_msg, sizeof(tokenizer->error_msg), "Неизвестный символ: \\0");
+    } else {
+        snprintf(tokenizer->error_msg, sizeof(tokenizer->error_msg), "Неизвестный символ: %c", c);
+    }
+    tokenizer->error = true;
+}
+
+// Заполняет следующее окно токенов. В конце строки окно заканчивается токеном TOKEN_END,
+// и повторные вызовы снова возвращают его.
+static void fill_tokens(Tokenizer *tokenizer) {
+    tokenizer->count = 0;
+    tokenizer->pos = 0;
+    while (tokenizer->count < tokenizer->capacity && !tokenizer->error) {
+        while (peek(tokenizer, 0) != '\0' && isspace(peek(tokenizer, 0))) bump(tokenizer);
+
+        Token *token = &tokenizer->tokens[tokenizer->count];
+        token->offset = tokenizer->offset;
+        token->value = 0;
+        char c = peek(tokenizer, 0);
+        if (c == '\0' && reader_at_line_end(tokenizer->in, 0)) {
+            token->type = TOKEN_END;
+        } else if (c == '+' || c == '/') {
+            token->type = c == '+' ? TOKEN_PLUS : TOKEN_SLASH;
+            bump(tokenizer);
+        } else if (isdigit(c) || (c == '-' && isdigit(peek(tokenizer, 1)))) {
+            token->type = TOKEN_NUMBER;
+            bool negative = c == '-';
+            if (negative) bump(tokenizer);
+            long long value = 0;
+            while (isdigit(peek(tokenizer, 0))) {
+                value = value * 10 + (peek(tokenizer, 0) - '0');
+                if (value > INT_MAX) {
+                    snprintf(tokenizer->error_msg, sizeof(tokenizer->error_msg),
+                             "Ошибка: число слишком большое (позиция %zu)", token->offset);
+                    tokenizer->error = true;
+                    return;
+                }
+                bump(tokenizer);
+            }
+            token->value = negative ? -(int)value : (int)value;
         } else {
-            fprintf(stderr, "Неизвестный символ: %c\n", *p);
-            exit(1);
+            report_unknown(tokenizer, c);
+            return;
         }
+        tokenizer->count++;
+        if (token->type == TOKEN_END) break;
     }
-    
-    // Выделение памяти и заполнение токенов
-    tokenizer.tokens = (char**)malloc(tokenizer.count * sizeof(char*));
-    p = input;
-    int i = 0;
-    while (*p) {
-        while (isspace(*p)) p++;
-        if (!*p) break;
-        
-        const char *start = p;
-        if (*p == '+' || *p == '/') {
-            p++;
-        } else if (isdigit(*p) || (*p == '-' && isdigit(*(p+1)))) {
-            if (*p == '-') p++;
-            while (isdigit(*p)) p++;
+}
+
+// Как и прежний двухпроходный токенизатор, отвергает строку с неизвестным символом в любом месте,
+// даже если разбор закончился раньше: иначе ответ зависел бы от того, попал ли символ в окно токенов
+static void check_rest_of_line(Tokenizer *tokenizer) {
+    while (!reader_at_line_end(tokenizer->in, 0)) {
+        char c = peek(tokenizer, 0);
+        if (!isspace(c) && !isdigit(c) && c != '+' && c != '/' && !(c == '-' && isdigit(peek(tokenizer, 1)))) {
+            report_unknown(tokenizer, c);
+            return;
         }
-        
-        int len = p - start;
-        tokenizer.tokens[i] = (char*)malloc(len + 1);
-        strncpy(tokenizer.tokens[i], start, len);
-        tokenizer.tokens[i][len] = '\0';
-        i++;
+        bump(tokenizer);
     }
-    
-    return tokenizer;
 }
 
-void free_tokenizer(Tokenizer *tokenizer) {
-    for (int i = 0; i < tokenizer->count; i++) {
-        free(tokenizer->tokens[i]);
+// Функции парсера
+static Token *current_token(Tokenizer *tokenizer) {
+    if (tokenizer->pos == tokenizer->count) {
+        fill_tokens(tokenizer);
     }
-    free(tokenizer->tokens);
+    return &tokenizer->tokens[tokenizer->pos];
 }
 
-// Функции парсера
-char* current_token(Tokenizer *tokenizer) {
-    if (tokenizer->pos < tokenizer->count) {
-        return tokenizer->tokens[tokenizer->pos];
+// Текст токена для сообщений об ошибках; исходные символы к этому моменту уже могут быть вытеснены из буфера
+static const char *token_text(Token *token, char *buffer, size_t size) {
+    switch (token->type) {
+        case TOKEN_NUMBER: snprintf(buffer, size, "%d", token->value); return buffer;
+        case TOKEN_PLUS: return "+";
+        case TOKEN_SLASH: return "/";
+        default: return "NULL";
     }
-    return NULL;
 }
 
-void consume(Tokenizer *tokenizer, const char *expected) {
-    char *token = current_token(tokenizer);
-    if (token && strcmp(token, expected) == 0) {
+static void consume(Tokenizer *tokenizer, TokenType expected, const char *text) {
+    Token *token = current_token(tokenizer);
+    if (tokenizer->error) return;
+    if (token->type == expected) {
         tokenizer->pos++;
     } else {
-        fprintf(stderr, "Ошибка: ожидалось '%s', получено '%s'\n", expected, token ? token : "NULL");
-        exit(1);
+        char buffer[16];
+        snprintf(tokenizer->error_msg, sizeof(tokenizer->error_msg),
+                 "Ошибка: ожидалось '%s', получено '%s'", text, token_text(token, buffer, sizeof(buffer)));
+        tokenizer->error = true;
     }
 }
 
-Fraction parse_number(Tokenizer *tokenizer) {
-    char *token = current_token(tokenizer);
-    if (token && (isdigit(token[0]) || (token[0] == '-' && isdigit(token[1])))) {
+static Fraction parse_number(Tokenizer *tokenizer) {
+    Token *token = current_token(tokenizer);
+    if (tokenizer->error) return (Fraction){0, 1};
+    if (token->type == TOKEN_NUMBER) {
         tokenizer->pos++;
-        return (Fraction){atoi(token), 1};
+        return (Fraction){token->value, 1};
     }
-    fprintf(stderr, "Ошибка: ожидалось число, получено '%s'\n", token ? token : "NULL");
-    exit(1);
+    char buffer[16];
+    snprintf(tokenizer->error_msg, sizeof(tokenizer->error_msg),
+             "Ошибка: ожидалось число, получено '%s'", token_text(token, buffer, sizeof(buffer)));
+    tokenizer->error = true;
+    return (Fraction){0, 1};
 }
 
-Fraction parse_T(Tokenizer *tokenizer) {
+static Fraction parse_T(Tokenizer *tokenizer) {
     Fraction numerator = parse_number(tokenizer);
-    consume(tokenizer, "/");
+    if (tokenizer->error) return numerator;
+    consume(tokenizer, TOKEN_SLASH, "/");
+    if (tokenizer->error) return numerator;
     Fraction denominator = parse_number(tokenizer);
+    if (tokenizer->error) return numerator;
     
     if (denominator.numerator == 0) {
-        fprintf(stderr, "Ошибка: деление на ноль\n");
-        exit(1);
+        snprintf(tokenizer->error_msg, sizeof(tokenizer->error_msg), "Ошибка: деление на ноль");
+        tokenizer->error = true;
+        return numerator;
     }
     
     return (Fraction){numerator.numerator, denominator.numerator};
 }
 
-Fraction parse_E(Tokenizer *tokenizer) {
+static Fraction parse_E(Tokenizer *tokenizer) {
     Fraction result = parse_T(tokenizer);
     
-    while (current_token(tokenizer) && strcmp(current_token(tokenizer), "+") == 0) {
-        consume(tokenizer, "+");
+    while (!tokenizer->error && current_token(tokenizer)->type == TOKEN_PLUS) {
+        consume(tokenizer, TOKEN_PLUS, "+");
         Fraction term = parse_T(tokenizer);
+        if (tokenizer->error) break;
         result = add_fractions(result, term);
     }
     
     return result;
 }
 
-Fraction parse_S(Tokenizer *tokenizer) {
+static Fraction parse_S(Tokenizer *tokenizer) {
     return parse_E(tokenizer);
 }
 
-int main() {
+// Вычисляет одно выражение; при ошибке возвращает false, а текст ошибки оставляет в error_msg
+static bool evaluate(Reader *in, Fraction *result, char *error_msg, size_t size) {
+    Token tokens[TOKEN_WINDOW];
+    Tokenizer tokenizer;
+    init_tokenizer(&tokenizer, in, tokens, TOKEN_WINDOW);
+    *result = parse_S(&tokenizer);
+    check_rest_of_line(&tokenizer);
+    if (tokenizer.error) {
+        snprintf(error_msg, size, "%s", tokenizer.error_msg);
+        return false;
+    }
+    simplify_fraction(result);
+    return true;
+}
+
+void v1_evaluate(const char *expression, size_t len, SeriesResult *result) {
+    Reader in;
+    reader_from_buffer(&in, expression, len);
+    Fraction value = {0, 1};
+    bool ok = evaluate(&in, &value, result->error_msg, sizeof(result->error_msg));
+    result->verdict = ok ? SERIES_OK : SERIES_SYNTAX_ERROR;
+    result->num = value.numerator;
+    result->den = value.denominator;
+    if (ok) {
+        result->error_msg[0] = '\0';
+    }
+}
+
+#ifndef ANALYZER_LIBRARY
+// Пакетный режим: по одному выражению на строку, по одной строке результата на выражение
+static int evaluate_stream(FILE *file) {
+    Reader in;
+    if (!reader_open(&in, file)) {
+        fprintf(stderr, "Ошибка: не удалось выделить буфер чтения\n");
+        return 1;
+    }
+    char error_msg[256];
+    while (!reader_at_end(&in)) {
+        Fraction result;
+        if (evaluate(&in, &result, error_msg, sizeof(error_msg))) {
+            printf("Результат: %d/%d\n", result.numerator, result.denominator);
+        } else {
+            printf("%s\n", error_msg);
+        }
+        reader_next_line(&in);
+    }
+    reader_close(&in);
+    return ferror(file) ? 1 : 0;
+}
+
+static int run_files(int count, char **paths) {
+    static char out_buffer[WRITE_BUFFER];
+    setvbuf(stdout, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    int status = 0;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(paths[i], "-") == 0) {
+            status |= evaluate_stream(stdin);
+            continue;
+        }
+        FILE *file = fopen(paths[i], "rb");
+        if (!file) {
+            fprintf(stderr, "Ошибка: не удалось открыть файл %s\n", paths[i]);
+            status = 1;
+            continue;
+        }
+        status |= evaluate_stream(file);
+        fclose(file);
+    }
+    fflush(stdout);
+    return status;
+}
+
+int main(int argc, char **argv) {
+    // Ключей нет: аргумент вида "-x" перед файлами - ошибка, а не имя файла
+    if (argc > 1 && argv[1][0] == '-' && argv[1][1] != '\0') {
+        fprintf(stderr, "Использование: %s [файл | -]...\n", argv[0]);
+        return 1;
+    }
+    if (argc > 1) {
+        return run_files(argc - 1, argv + 1);
+    }
+
     char input[100];
     printf("Введите выражение (например: 1/2 + 3/4 + 5/6): ");
     fgets(input, sizeof(input), stdin);
     input[strcspn(input, "\n")] = '\0'; // Удаляем символ новой строки
     
-    Tokenizer tokenizer = tokenize(input);
-    Fraction result = parse_S(&tokenizer);
-    simplify_fraction(&result);
+    Reader in;
+    reader_from_string(&in, input);
+    Fraction result;
+    char error_msg[256];
+    if (!evaluate(&in, &result, error_msg, sizeof(error_msg))) {
+        fprintf(stderr, "%s\n", error_msg);
+        return 1;
+    }
     
     printf("Результат: %d/%d\n", result.numerator, result.denominator);
-    
-    free_tokenizer(&tokenizer);
     return 0;
 }
+#endif